@@ -0,0 +1,235 @@
+#include "Aggregate.hpp"
+
+#include "Join.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+AggOp parse_agg_op(const char* name) {
+	if (strcmp(name, "count") == 0) {
+		return AggOp::COUNT;
+	} else if (strcmp(name, "sum") == 0) {
+		return AggOp::SUM;
+	} else if (strcmp(name, "min") == 0) {
+		return AggOp::MIN;
+	} else if (strcmp(name, "max") == 0) {
+		return AggOp::MAX;
+	}
+	cerr << "Error: unknown aggregate function " << name
+	     << ", expected count, sum, min or max." << endl;
+	exit(1);
+}
+
+/* Value a record contributes to its group */
+static long long agg_value(const Record& r, AggOp op) {
+	if (op == AggOp::COUNT) {
+		return 1;
+	}
+	const char* data = r.get_data().c_str();
+	char* end = nullptr;
+	errno = 0;
+	long long value = strtoll(data, &end, 10);
+	if (*data == '\0' || *end != '\0' || errno == ERANGE) {
+		cerr << "Error: can not aggregate non-integer data " << data
+		     << " of key " << r.get_key() << "." << endl;
+		exit(1);
+	}
+	return value;
+}
+
+static long long agg_combine(long long state, long long value, AggOp op) {
+	switch (op) {
+	case AggOp::MIN:
+		return min(state, value);
+	case AggOp::MAX:
+		return max(state, value);
+	default:
+		return state + value;
+	}
+}
+
+/*
+ * Fold value into the group of key in the hash table made of
+ * mem pages [table_first, table_first + table_size).
+ * A group whose hash page is full goes to the next page with room, so the
+ * whole table fills up before this returns false for a new group.
+ */
+static bool accumulate(Mem* mem, uint table_first, uint table_size,
+                       Record key, long long value, AggOp op) {
+	uint hash_val = key.probe_hash() % table_size;
+	for (uint k = 0; k < table_size; ++k) {
+		Page* table_page = mem->mem_page(table_first + (hash_val + k) % table_size);
+		for (uint i = 0; i < table_page->size(); ++i) {
+			Record group = table_page->get_record(i);
+			if (group == key) {
+				long long state = stoll(group.get_data());
+				table_page->set_record(
+				    i, Record(key.get_key(), to_string(agg_combine(state, value, op))));
+				return true;
+			}
+		}
+		// pages are never emptied while aggregating, so the group of key can
+		// only be in a page that was full when it was created
+		if (!table_page->full()) {
+			table_page->loadRecord(Record(key.get_key(), to_string(value)));
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Fold value into its group, or write it as a partial group to the spill
+ * buffer (memory page mem->size() - 3) when the hash table is full
+ */
+static void fold(Disk* disk, Mem* mem, uint table_first, uint table_size,
+                 const Record& key, long long value, AggOp op,
+                 vector<uint>& spill_pages) {
+	if (accumulate(mem, table_first, table_size, key, value, op)) {
+		return;
+	}
+	Page* spill_page = mem->mem_page(mem->size() - 3);
+	if (spill_page->full()) {
+		spill_pages.push_back(mem->flushToDisk(disk, mem->size() - 3));
+	}
+	spill_page->loadRecord(Record(key.get_key(), to_string(value)));
+}
+
+/* Flush the partially filled spill buffer */
+static void finish_spill(Disk* disk, Mem* mem, vector<uint>& spill_pages) {
+	if (!mem->mem_page(mem->size() - 3)->empty()) {
+		spill_pages.push_back(mem->flushToDisk(disk, mem->size() - 3));
+	}
+}
+
+/*
+ * Move every group of the hash table into the output buffer (the last memory
+ * page), flushing it to disk whenever it is full, and empty the hash table
+ */
+static void emit_groups(Disk* disk, Mem* mem, uint table_first,
+                        uint table_size, vector<uint>& disk_pages) {
+	Page* output_page = mem->mem_page(mem->size() - 1);
+	for (uint m = table_first; m < table_first + table_size; ++m) {
+		Page* table_page = mem->mem_page(m);
+		for (uint i = 0; i < table_page->size(); ++i) {
+			if (output_page->full()) {
+				disk_pages.push_back(mem->flushToDisk(disk, mem->size() - 1));
+			}
+			output_page->loadRecord(table_page->get_record(i));
+		}
+		table_page->reset();
+	}
+}
+
+/* Flush the partially filled output buffer and reset memory */
+static void finish_output(Disk* disk, Mem* mem, vector<uint>& disk_pages) {
+	if (!mem->mem_page(mem->size() - 1)->empty()) {
+		disk_pages.push_back(mem->flushToDisk(disk, mem->size() - 1));
+	}
+	mem->reset();
+}
+
+/*
+ * Aggregate the partial groups of spill_pages in as many passes as needed.
+ * Each pass aggregates the groups that fit in the hash table
+ * [0, mem->size() - 3), emits them, and spills the rest for the next pass.
+ * A key spilled in a pass never has a group in that pass, so every key is
+ * emitted exactly once.
+ */
+static void aggregate_spill(Disk* disk, Mem* mem, vector<uint> spill_pages,
+                            AggOp op, vector<uint>& disk_pages) {
+	uint table_size = mem->size() - 3;
+	uint input_page_id = mem->size() - 2;
+	while (!spill_pages.empty()) {
+		vector<uint> next_spill_pages;
+		for (uint page_id : spill_pages) {
+			mem->loadFromDisk(disk, page_id, input_page_id);
+			Page* input_page = mem->mem_page(input_page_id);
+			for (uint i = 0; i < input_page->size(); ++i) {
+				Record partial = input_page->get_record(i);
+				fold(disk, mem, 0, table_size, partial, stoll(partial.get_data()),
+				     op, next_spill_pages);
+			}
+		}
+		finish_spill(disk, mem, next_spill_pages);
+		emit_groups(disk, mem, 0, table_size, disk_pages);
+		spill_pages = next_spill_pages;
+	}
+}
+
+vector<uint> aggregate(Disk* disk, Mem* mem, pair<uint, uint> rel, AggOp op) {
+	if (mem->size() < 4) {
+		cerr << "Error: aggregating needs at least 4 memory pages." << endl;
+		exit(1);
+	}
+	vector<uint> disk_pages;
+	vector<Bucket> partitions = partition_left(disk, mem, rel);
+
+	// pages [0, mem->size() - 3) are the hash table,
+	// then the spill, input and output buffers
+	uint table_size = mem->size() - 3;
+	uint input_page_id = mem->size() - 2;
+	for (Bucket& bucket : partitions) {
+		vector<uint> spill_pages;
+		for (uint page_id : bucket.get_left_rel()) {
+			mem->loadFromDisk(disk, page_id, input_page_id);
+			Page* input_page = mem->mem_page(input_page_id);
+			for (uint i = 0; i < input_page->size(); ++i) {
+				Record record = input_page->get_record(i);
+				fold(disk, mem, 0, table_size, record, agg_value(record, op), op,
+				     spill_pages);
+			}
+		}
+		finish_spill(disk, mem, spill_pages);
+		emit_groups(disk, mem, 0, table_size, disk_pages);
+		aggregate_spill(disk, mem, spill_pages, op, disk_pages);
+	}
+
+	finish_output(disk, mem, disk_pages);
+	return disk_pages;
+}
+
+vector<uint> probe_aggregate(Disk* disk, Mem* mem, vector<Bucket>& partitions,
+                             AggOp op) {
+	if (mem->size() < 5) {
+		cerr << "Error: aggregating a join needs at least 5 memory pages."
+		     << endl;
+		exit(1);
+	}
+	vector<uint> disk_pages;
+
+	uint left_size = 0, right_size = 0;
+	for (Bucket& b : partitions) {
+		left_size += b.num_left_rel_record;
+		right_size += b.num_right_rel_record;
+	}
+
+	// pages [0, build_size) hash the smaller relation,
+	// pages [build_size, mem->size() - 3) hold the aggregation table
+	uint build_size = (mem->size() - 3) / 2;
+	uint table_size = mem->size() - 3 - build_size;
+
+	for (Bucket& bucket : partitions) {
+		vector<uint> spill_pages;
+		// the matching pair is folded into its group, never written out
+		auto fold_pair = [&](const Record&, const Record& right_record) {
+			fold(disk, mem, build_size, table_size, right_record,
+			     agg_value(right_record, op), op, spill_pages);
+		};
+		probe_bucket(disk, mem, bucket, left_size <= right_size, build_size,
+		             fold_pair);
+		finish_spill(disk, mem, spill_pages);
+		emit_groups(disk, mem, build_size, table_size, disk_pages);
+		// the build relation is done with, the spilled groups get the whole table
+		aggregate_spill(disk, mem, spill_pages, op, disk_pages);
+	}
+
+	finish_output(disk, mem, disk_pages);
+	return disk_pages;
+}
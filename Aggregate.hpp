@@ -0,0 +1,60 @@
+/*
+ * This file defines the group-by aggregation operators, which reuse the
+ * partition phase of GHJ and aggregate each bucket with an in-memory hash table
+ */
+#ifndef _AGGREGATE_HPP_
+#define _AGGREGATE_HPP_
+
+#include "Bucket.hpp"
+#include "Mem.hpp"
+
+/*
+ * Aggregate functions over the data of the records of each key.
+ * SUM, MIN and MAX interpret the data as a signed integer.
+ */
+enum class AggOp { COUNT, SUM, MIN, MAX };
+
+/* Parse "count", "sum", "min" or "max" into an AggOp */
+AggOp parse_agg_op(const char* name);
+
+/*
+ * aggregate function
+ *
+ * Input:
+ * disk: pointer of Disk object
+ * mem: pointer of Memory object
+ * rel: [rel.first, rel.second) will be the range of page ids of the relation to aggregate
+ * op: aggregate function to apply
+ *
+ * The relation is partitioned into mem->size() - 1 buckets, each aggregated
+ * in a hash table of mem->size() - 3 pages. The groups of a bucket that do
+ * not fit are spilled to disk and aggregated in further passes, so mem must
+ * have at least 4 pages.
+ *
+ * Output:
+ * A vector of page ids holding one record per key, whose data is the aggregate.
+*/
+std::vector<uint> aggregate(Disk* disk, Mem* mem, std::pair<uint, uint> rel,
+                            AggOp op);
+
+/*
+ * probe_aggregate function
+ * Input:
+ * disk: pointer of Disk object
+ * mem: pointer of Memory object
+ * partition: a reference to a vector of buckets from partition function
+ * op: aggregate function to apply
+ *
+ * Probe phase that aggregates the data of the right record of every matching
+ * pair by join key instead of writing out the pairs.
+ * The mem->size() - 3 hash table pages are split between the build side and
+ * the aggregation table, so mem must have at least 5 pages. Groups that do
+ * not fit are spilled and aggregated once the bucket is joined.
+ *
+ * Output:
+ * A vector of page ids holding one record per joined key, whose data is the aggregate.
+*/
+std::vector<uint> probe_aggregate(Disk* disk, Mem* mem,
+                                  std::vector<Bucket>& partition, AggOp op);
+
+#endif
@@ -0,0 +1,142 @@
+#include "ColumnarFile.hpp"
+
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define COLUMNAR_FILE_MAGIC "GHJCOL01"
+#define COLUMNAR_FILE_MAGIC_LEN 8
+
+/* num_rows, the offsets and bytes position of each column, magic */
+#define FOOTER_SIZE (8 + 16 * NUM_COLUMNS + COLUMNAR_FILE_MAGIC_LEN)
+
+static void write_uint64(ofstream& out, uint64_t value) {
+	out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void write_columnar(const char* filename, Disk* disk, vector<uint>& join_res) {
+	ofstream out(filename, ios::binary | ios::trunc);
+	if (!out) {
+		cerr << "Error: can not open " << filename << " for writing." << endl;
+		exit(1);
+	}
+
+	/* One pass over the result pages fills the offsets and bytes of every column */
+	vector<uint64_t> offsets[NUM_COLUMNS];
+	string bytes[NUM_COLUMNS];
+	for (uint c = 0; c < NUM_COLUMNS; ++c) {
+		offsets[c].push_back(0);
+	}
+	for (uint page_id : join_res) {
+		Page* page = disk->diskRead(page_id);
+		for (uint r = 0; r + 1 < page->size(); r += 2) {
+			const Record& left = page->get_record(r);
+			const Record& right = page->get_record(r + 1);
+			bytes[static_cast<uint>(Column::LEFT_KEY)] += left.get_key();
+			bytes[static_cast<uint>(Column::LEFT_DATA)] += left.get_data();
+			bytes[static_cast<uint>(Column::RIGHT_KEY)] += right.get_key();
+			bytes[static_cast<uint>(Column::RIGHT_DATA)] += right.get_data();
+			for (uint c = 0; c < NUM_COLUMNS; ++c) {
+				offsets[c].push_back(bytes[c].size());
+			}
+		}
+	}
+
+	out.write(COLUMNAR_FILE_MAGIC, COLUMNAR_FILE_MAGIC_LEN);
+	uint64_t pos = COLUMNAR_FILE_MAGIC_LEN;
+	uint64_t offsets_pos[NUM_COLUMNS], data_pos[NUM_COLUMNS];
+	for (uint c = 0; c < NUM_COLUMNS; ++c) {
+		offsets_pos[c] = pos;
+		out.write(reinterpret_cast<const char*>(offsets[c].data()),
+		          offsets[c].size() * sizeof(uint64_t));
+		pos += offsets[c].size() * sizeof(uint64_t);
+
+		data_pos[c] = pos;
+		/* Keep the next offsets array 8-byte aligned */
+		bytes[c].resize((bytes[c].size() + sizeof(uint64_t) - 1)
+		                / sizeof(uint64_t) * sizeof(uint64_t));
+		out.write(bytes[c].data(), bytes[c].size());
+		pos += bytes[c].size();
+	}
+
+	write_uint64(out, offsets[0].size() - 1);
+	for (uint c = 0; c < NUM_COLUMNS; ++c) {
+		write_uint64(out, offsets_pos[c]);
+		write_uint64(out, data_pos[c]);
+	}
+	out.write(COLUMNAR_FILE_MAGIC, COLUMNAR_FILE_MAGIC_LEN);
+	out.close();
+	if (!out) {
+		cerr << "Error: failed to write " << filename << "." << endl;
+		exit(1);
+	}
+}
+
+static void invalid_file(const char* filename) {
+	cerr << "Error: " << filename << " is not a valid columnar file." << endl;
+	exit(1);
+}
+
+ColumnarReader::ColumnarReader(const char* filename) {
+	int fd = open(filename, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		cerr << "Error: can not open " << filename << " for reading." << endl;
+		exit(1);
+	}
+	file_size = st.st_size;
+	if (file_size < COLUMNAR_FILE_MAGIC_LEN + FOOTER_SIZE) {
+		invalid_file(filename);
+	}
+	void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) {
+		cerr << "Error: can not map " << filename << " into memory." << endl;
+		exit(1);
+	}
+	base = static_cast<const char*>(mapped);
+
+	const char* footer = base + file_size - FOOTER_SIZE;
+	if (string(base, COLUMNAR_FILE_MAGIC_LEN) != COLUMNAR_FILE_MAGIC
+	    || string(base + file_size - COLUMNAR_FILE_MAGIC_LEN,
+	              COLUMNAR_FILE_MAGIC_LEN)
+	           != COLUMNAR_FILE_MAGIC
+	    || (file_size - FOOTER_SIZE) % sizeof(uint64_t) != 0) {
+		invalid_file(filename);
+	}
+	/* The footer is 8-byte aligned, as every section before it is padded */
+	const uint64_t* fields = reinterpret_cast<const uint64_t*>(footer);
+	rows = fields[0];
+	uint64_t body_end = file_size - FOOTER_SIZE;
+	for (uint c = 0; c < NUM_COLUMNS; ++c) {
+		uint64_t offsets_pos = fields[1 + 2 * c];
+		uint64_t data_pos = fields[2 + 2 * c];
+		if (offsets_pos % sizeof(uint64_t) != 0 || offsets_pos > body_end
+		    || rows >= (body_end - offsets_pos) / sizeof(uint64_t)) {
+			invalid_file(filename);
+		}
+		offsets[c] = reinterpret_cast<const uint64_t*>(base + offsets_pos);
+		if (data_pos > body_end || offsets[c][rows] > body_end - data_pos) {
+			invalid_file(filename);
+		}
+		data[c] = base + data_pos;
+	}
+}
+
+ColumnarReader::~ColumnarReader() {
+	munmap(const_cast<char*>(base), file_size);
+}
+
+uint64_t ColumnarReader::num_rows() const { return rows; }
+
+pair<const char*, size_t> ColumnarReader::get(Column column,
+                                              uint64_t row) const {
+	uint c = static_cast<uint>(column);
+	return make_pair(data[c] + offsets[c][row],
+	                 offsets[c][row + 1] - offsets[c][row]);
+}
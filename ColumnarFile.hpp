@@ -0,0 +1,62 @@
+/*
+ * This file defines the columnar binary file format for join results and its
+ * reader, which maps the file into memory and scans it without parsing
+ */
+#ifndef _COLUMNAR_FILE_HPP_
+#define _COLUMNAR_FILE_HPP_
+
+#include "Disk.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/* Columns of a join result file, one row per matching pair */
+enum class Column { LEFT_KEY, LEFT_DATA, RIGHT_KEY, RIGHT_DATA };
+
+const uint NUM_COLUMNS = 4;
+
+/*
+ * write_columnar function
+ *
+ * Input:
+ * filename: file to write
+ * disk: pointer of Disk object
+ * join_res: a reference to a vector of page ids from probe function
+ *
+ * File layout, all integers being native endian uint64:
+ * magic, then for each column an array of num_rows + 1 offsets followed by
+ * the bytes of the column padded to 8 bytes, then a footer with num_rows,
+ * the file position of the offsets and bytes of each column, and the magic.
+ * Field row of a column spans bytes [offsets[row], offsets[row + 1]).
+*/
+void write_columnar(const char* filename, Disk* disk,
+                    std::vector<uint>& join_res);
+
+class ColumnarReader {
+public:
+	/* Map filename, written by write_columnar, into memory */
+	explicit ColumnarReader(const char* filename);
+
+	~ColumnarReader();
+
+	ColumnarReader(const ColumnarReader&) = delete;
+	ColumnarReader& operator=(const ColumnarReader&) = delete;
+
+	/* Return number of rows in the file */
+	uint64_t num_rows() const;
+
+	/*
+     * Return the field of column at row as a pointer into the mapped file
+     * and its length. The field is not null terminated.
+     */
+	std::pair<const char*, size_t> get(Column column, uint64_t row) const;
+
+private:
+	const char* base = nullptr;
+	size_t file_size = 0;
+	uint64_t rows = 0;
+	const uint64_t* offsets[NUM_COLUMNS];
+	const char* data[NUM_COLUMNS];
+};
+
+#endif
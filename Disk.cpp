@@ -5,7 +5,8 @@
 
 using namespace std;
 
-Disk::Disk() = default;
+Disk::Disk(uint _size_in_page, uint _records_per_page)
+    : size_in_page(_size_in_page), records_per_page(_records_per_page) {}
 
 Disk::~Disk() {
 	for (auto& page : pages) {
@@ -14,7 +15,8 @@ Disk::~Disk() {
 }
 
 uint Disk::diskWrite(shared_ptr<Page>& p) {
-	if (pages.size() == DISK_SIZE_IN_PAGE) {
+	lock_guard<mutex> lock(pages_mutex);
+	if (pages.size() == size_in_page) {
 		cerr << "Error: can not write to the disk due to out of disk space."
 		     << endl;
 		exit(1);
@@ -25,6 +27,7 @@ uint Disk::diskWrite(shared_ptr<Page>& p) {
 }
 
 Page* Disk::diskRead(uint pos) {
+	lock_guard<mutex> lock(pages_mutex);
 	if (pos >= pages.size()) {
 		cerr << "Error: accessing invalid disk page." << endl;
 		exit(1);
@@ -32,9 +35,15 @@ Page* Disk::diskRead(uint pos) {
 	return pages[pos].get();
 }
 
-void Disk::print(uint id) { pages[id]->print(); }
+uint Disk::page_capacity() const { return records_per_page; }
+
+void Disk::print(uint id) {
+	lock_guard<mutex> lock(pages_mutex);
+	pages[id]->print();
+}
 
 void Disk::print() {
+	lock_guard<mutex> lock(pages_mutex);
 	for (uint i = 0; i < pages.size(); i++) {
 		if (pages[i]) {
 			cout << "Disk page id: " << i << endl;
@@ -49,13 +58,14 @@ pair<uint, uint> Disk::read_data(const char* filename) {
 	string str_file_name(filename);
 	ifstream raw_data_file(str_file_name);
 	string one_line;
+	lock_guard<mutex> lock(pages_mutex);
 	uint start_page_id = pages.size();
 	/* Create the first new disk page */
-	pages.push_back(make_shared<Page>());
+	pages.push_back(make_shared<Page>(records_per_page));
 	while (getline(raw_data_file, one_line)) {
 		if (pages.back()->full()) {
 			/* Create a new disk page */
-			pages.push_back(make_shared<Page>());
+			pages.push_back(make_shared<Page>(records_per_page));
 		}
 		size_t space_idx = one_line.find(' ');
 		string key = one_line.substr(0, space_idx);
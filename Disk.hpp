@@ -4,10 +4,17 @@
 #include "Page.hpp"
 
 #include <memory>
+#include <mutex>
 
+/*
+ * Disk is safe to share between threads: pages are only appended, and a page
+ * is never modified after it is written
+ */
 class Disk {
 public:
-	Disk();
+	/* A disk of _size_in_page pages, each holding _records_per_page records */
+	explicit Disk(uint _size_in_page = DISK_SIZE_IN_PAGE,
+	              uint _records_per_page = RECORDS_PER_PAGE);
 
 	~Disk();
 
@@ -17,6 +24,9 @@ public:
 	// Do not directly use this function in Join.cpp
 	Page* diskRead(uint pos);
 
+	// Number of records each page of this disk holds
+	uint page_capacity() const;
+
 	// Inspect the content of page in disk with specific id
 	void print(uint id);
 
@@ -29,6 +39,13 @@ public:
 
 private:
 	std::vector<std::shared_ptr<Page>> pages;
+
+	uint size_in_page;
+
+	uint records_per_page;
+
+	// Guards pages
+	mutable std::mutex pages_mutex;
 };
 
 #endif
\ No newline at end of file
@@ -1,23 +1,21 @@
 #include "Join.hpp"
 
+#include <iostream>
 #include <vector>
 
 using namespace std;
 
 /*
- * Input: Disk, Memory, Disk page ids for left relation, Disk page ids for right relation
- * Output: Vector of Buckets of size (MEM_SIZE_IN_PAGE - 1) after partition
+ * Input: Disk, Memory, Disk page ids for one relation, Buckets to fill, which side the relation is
+ * Output: the relation's records are spread over partitions by partition_hash()
  */
-vector<Bucket> partition(Disk* disk, Mem* mem, pair<uint, uint> left_rel,
-                         pair<uint, uint> right_rel) {
-	// output vector
-	vector<Bucket> partitions(MEM_SIZE_IN_PAGE - 1, Bucket(disk));
-
-	//when referencing pseudo code in spec, left_rel is R and right_rel is S
+static void partition_relation(Disk* disk, Mem* mem, pair<uint, uint> rel,
+                               vector<Bucket>& partitions, bool is_left) {
+	uint fanout = partitions.size();
 
-	//1. for each disk page in left_rel:
-	//	1. load from disk into memory page left_rel_page
-	//	2. for each tuple in left_rel_page:
+	//1. for each disk page in rel:
+	//	1. load from disk into memory page rel_page
+	//	2. for each tuple in rel_page:
 	//			1. hash tuple key
 	//			2. load tuple into buffer page specified by hash
 	//			3. if buffer page accessed is full, flush buffer to disk and add its disk page id to corresponding bucket.
@@ -26,78 +24,168 @@ vector<Bucket> partition(Disk* disk, Mem* mem, pair<uint, uint> left_rel,
 	//			1. if page isn't empty, flush page to disk and add its disk page id to bucket
 	//			(this will flush mem pages that are only partially full in the previous loop)
 	//2. reset memory
-	//3. do the same for right_rel, with appropriate changes to functions used
 
-	// partitioning left_rel
-	for(uint i = left_rel.first; i < left_rel.second; ++i)
+	for(uint i = rel.first; i < rel.second; ++i)
 	{
-		// memory page with id MEM_SIZE_IN_PAGE - 1 is the input buffer
-		mem->loadFromDisk(disk, i, MEM_SIZE_IN_PAGE - 1);
-		for(uint r = 0; r < mem->mem_page(MEM_SIZE_IN_PAGE - 1)->size(); ++r)
+		// memory page with id mem->size() - 1 is the input buffer
+		mem->loadFromDisk(disk, i, mem->size() - 1);
+		for(uint r = 0; r < mem->mem_page(mem->size() - 1)->size(); ++r)
 		{
-			Record record = mem->mem_page(MEM_SIZE_IN_PAGE - 1)->get_record(r);
+			Record record = mem->mem_page(mem->size() - 1)->get_record(r);
 			//hash is the mem_page_id of the page where record is going
 			//buffer is the pointer to that page
-			uint hash = record.partition_hash() % (MEM_SIZE_IN_PAGE - 1);
+			uint hash = record.partition_hash() % fanout;
 			Page* buffer = mem->mem_page(hash);
-			if(!buffer->full())
+			if(buffer->full())
 			{
-				buffer->loadRecord(record);
-			}
-			else
-			{
-				partitions[hash].add_left_rel_page(mem->flushToDisk(disk, hash));
-				buffer->loadRecord(record);
+				uint page_id = mem->flushToDisk(disk, hash);
+				if(is_left)
+				{
+					partitions[hash].add_left_rel_page(page_id);
+				}
+				else
+				{
+					partitions[hash].add_right_rel_page(page_id);
+				}
 			}
+			buffer->loadRecord(record);
 		}
-		
 	}
 
-	for(uint m = 0; m < MEM_SIZE_IN_PAGE - 1; ++m)
+	for(uint m = 0; m < fanout; ++m)
 	{
 		Page* p = mem->mem_page(m);
 		if(!p->empty())
 		{
-			partitions[m].add_left_rel_page(mem->flushToDisk(disk, m));
-		}
-	}
-
-	mem->reset();
-
-	for(uint i = right_rel.first; i < right_rel.second; ++i)
-	{
-		// memory page with id MEM_SIZE_IN_PAGE - 1 is the input buffer
-		mem->loadFromDisk(disk, i, MEM_SIZE_IN_PAGE - 1);
-		for(uint r = 0; r < mem->mem_page(MEM_SIZE_IN_PAGE - 1)->size(); ++r)
-		{
-			Record record = mem->mem_page(MEM_SIZE_IN_PAGE - 1)->get_record(r);
-			uint hash = record.partition_hash() % (MEM_SIZE_IN_PAGE - 1);
-			Page* buffer = mem->mem_page(hash);
-			if(!buffer->full())
+			uint page_id = mem->flushToDisk(disk, m);
+			if(is_left)
 			{
-				buffer->loadRecord(record);
+				partitions[m].add_left_rel_page(page_id);
 			}
 			else
 			{
-				partitions[hash].add_right_rel_page(mem->flushToDisk(disk, hash));
-				buffer->loadRecord(record);
+				partitions[m].add_right_rel_page(page_id);
 			}
 		}
-		
 	}
 
-	for(uint m = 0; m < MEM_SIZE_IN_PAGE - 1; ++m)
+	mem->reset();
+}
+
+/*
+ * Input: Disk, Memory, Disk page ids for left relation, Disk page ids for right relation
+ * Output: Vector of Buckets of size (mem->size() - 1) after partition
+ */
+vector<Bucket> partition(Disk* disk, Mem* mem, pair<uint, uint> left_rel,
+                         pair<uint, uint> right_rel) {
+	//when referencing pseudo code in spec, left_rel is R and right_rel is S
+	vector<Bucket> partitions = partition_left(disk, mem, left_rel);
+	partition_relation(disk, mem, right_rel, partitions, false);
+
+	return partitions;
+}
+
+/*
+ * Input: Disk, Memory, Disk page ids for left relation
+ * Output: Vector of Buckets of size (mem->size() - 1) holding only the left relation
+ */
+vector<Bucket> partition_left(Disk* disk, Mem* mem, pair<uint, uint> left_rel) {
+	// output vector
+	vector<Bucket> partitions(mem->size() - 1, Bucket(disk));
+	partition_relation(disk, mem, left_rel, partitions, true);
+	return partitions;
+}
+
+/*
+ * Input: Disk, Memory, Buckets already holding the left relation, Disk page ids for right relation
+ * Output: right relation added to partitions, using partitions.size() as the fanout
+ */
+void partition_right(Disk* disk, Mem* mem, vector<Bucket>& partitions,
+                     pair<uint, uint> right_rel) {
+	if (partitions.empty() || partitions.size() > mem->size() - 1) {
+		cerr << "Error: memory is too small for a fanout of "
+		     << partitions.size() << " buckets." << endl;
+		exit(1);
+	}
+	partition_relation(disk, mem, right_rel, partitions, false);
+}
+
+/*
+ * Input: Disk, Memory, Bucket, which relation to build from, hash table size, callback for matches
+ * Output: on_match called with (left record, right record) of every matching pair in the bucket
+ */
+void probe_bucket(Disk* disk, Mem* mem, Bucket& bucket, bool build_is_left,
+                  uint table_size,
+                  const function<void(const Record&, const Record&)>& on_match) {
+	// Build phase: Load smaller relation into a hash table in memory
+	vector<uint> smaller_relation, larger_relation;
+
+	if(!build_is_left)
 	{
-		Page* p = mem->mem_page(m);
-		if(!p->empty())
-		{
-			partitions[m].add_right_rel_page(mem->flushToDisk(disk, m));
-		}
+		smaller_relation = bucket.get_right_rel();
+		larger_relation = bucket.get_left_rel();
+	}
+	else
+	{
+		smaller_relation = bucket.get_left_rel();
+		larger_relation = bucket.get_right_rel();
 	}
 
-	mem->reset();
+	// A bucket whose smaller relation overflows a hash page is joined in
+	// several passes: each pass builds the hash table from the next chunk
+	// of the smaller relation and probes it with the whole larger relation
+	uint next_page = 0, next_record = 0;
+	while (next_page < smaller_relation.size()) {
+		bool table_full = false;
+		while (next_page < smaller_relation.size() && !table_full) {
+			mem->loadFromDisk(disk, smaller_relation[next_page], mem->size() - 2);  // Load disk page to memory
+			Page* mem_page = mem->mem_page(mem->size() - 2);
+			for (; next_record < mem_page->size(); ++next_record) {
+				Record record = mem_page->get_record(next_record);
+				uint hash_val = record.probe_hash() % table_size;
+				if (mem->mem_page(hash_val)->full()) {
+					table_full = true;
+					break;
+				}
+				mem->mem_page(hash_val)->loadRecord(record);  // Insert into hashed memory page
+			}
+			if (!table_full) {
+				++next_page;
+				next_record = 0;
+			}
+		}
 
-	return partitions;
+		//input buffer doesn't need to be flushed since we don't need to write anything new back
+
+		//we can't flush the hash table because we need it in memory
+
+		// Probe phase: Match larger relation tuples against hash table
+		for (uint page_id : larger_relation) {
+			mem->loadFromDisk(disk, page_id, mem->size() - 2);  // Load page to memory
+			Page* probe_page = mem->mem_page(mem->size() - 2);
+			for (uint i = 0; i < probe_page->size(); ++i) {
+				Record probe_record = probe_page->get_record(i);
+				uint hash_val = probe_record.probe_hash() % table_size;
+				Page* hash_page = mem->mem_page(hash_val);  // Access corresponding hash page
+				for (uint j = 0; j < hash_page->size(); ++j) {
+					const Record& hash_record = hash_page->get_record(j);
+					if (probe_record == hash_record) {  // Matching records
+						// left relation record first
+						if (build_is_left) {
+							on_match(hash_record, probe_record);
+						} else {
+							on_match(probe_record, hash_record);
+						}
+					}
+				}
+			}
+		}
+
+		//reset hash table in prepation for the next chunk or partition
+		for (uint mem_page = 0; mem_page < table_size; ++mem_page) {
+			mem->mem_page(mem_page)->reset();
+		}
+	}
 }
 
 /*
@@ -105,7 +193,8 @@ vector<Bucket> partition(Disk* disk, Mem* mem, pair<uint, uint> left_rel,
  * Output: Vector of disk page ids for join result
  */
 
-vector<uint> probe(Disk* disk, Mem* mem, vector<Bucket>& partitions) {
+vector<uint> probe(Disk* disk, Mem* mem, vector<Bucket>& partitions,
+                   const function<void()>& before_bucket) {
     vector<uint> disk_pages;  // To store the resulting disk page IDs of the join output
 
 	uint left_size = 0, right_size = 0;
@@ -115,78 +204,29 @@ vector<uint> probe(Disk* disk, Mem* mem, vector<Bucket>& partitions) {
 		right_size += b.num_right_rel_record;
 	}
 
+    // Write matched pair to the output buffer
+    auto write_pair = [&](const Record& left_record, const Record& right_record) {
+        Page* output_page = mem->mem_page(mem->size() - 1);
+        if (output_page->full()) {
+            uint flushed_page_id = mem->flushToDisk(disk, mem->size() - 1);
+            disk_pages.push_back(flushed_page_id);  // Store output page ID
+        }
+        output_page->loadPair(left_record, right_record);
+    };
 
     // Iterate over each bucket/partition
     for (auto& bucket : partitions) {
-
-        // Build phase: Load smaller relation into a hash table in memory
-		vector<uint> smaller_relation, larger_relation;
-
-		if(left_size > right_size)
-		{
-			smaller_relation = bucket.get_right_rel();
-			larger_relation = bucket.get_left_rel();
-		}
-		else
-		{
-			smaller_relation = bucket.get_left_rel();
-			larger_relation = bucket.get_right_rel();
-		}
-        
-        for (uint page_id : smaller_relation) {
-            mem->loadFromDisk(disk, page_id, MEM_SIZE_IN_PAGE - 2);  // Load disk page to memory
-            Page* mem_page = mem->mem_page(MEM_SIZE_IN_PAGE - 2);
-            for (uint i = 0; i < mem_page->size(); ++i) {
-                Record record = mem_page->get_record(i);
-                uint hash_val = record.probe_hash() % (MEM_SIZE_IN_PAGE - 2);
-                mem->mem_page(hash_val)->loadRecord(record);  // Insert into hashed memory page
-            }
-        }
-		
-		//input buffer doesn't need to be flushed since we don't need to write anything new back
-
-		//we can't flush the hash table because we need it in memory
-        // Flush hash table to disk for large relations
-        // for (uint i = 0; i < MEM_SIZE_IN_PAGE - 2; ++i) {
-        //     if (!mem->mem_page(i)->empty()) {
-        //         mem->flushToDisk(disk, i);  // Flush memory page to disk
-        //     }
-        // }
-
-        // Probe phase: Match larger relation tuples against hash table
-        for (uint page_id : larger_relation) {
-            mem->loadFromDisk(disk, page_id, MEM_SIZE_IN_PAGE - 2);  // Load page to memory
-            Page* probe_page = mem->mem_page(MEM_SIZE_IN_PAGE - 2);
-            for (uint i = 0; i < probe_page->size(); ++i) {
-                Record probe_record = probe_page->get_record(i);
-                uint hash_val = probe_record.probe_hash() % (MEM_SIZE_IN_PAGE - 2);
-                Page* hash_page = mem->mem_page(hash_val);  // Access corresponding hash page
-                for (uint j = 0; j < hash_page->size(); ++j) {
-                    Record hash_record = hash_page->get_record(j);
-                    if (probe_record == hash_record) {  // Matching records
-                        Page* output_page = mem->mem_page(MEM_SIZE_IN_PAGE - 1);
-                        if (output_page->full()) {
-                            uint flushed_page_id = mem->flushToDisk(disk, MEM_SIZE_IN_PAGE - 1);
-                            disk_pages.push_back(flushed_page_id);  // Store output page ID
-                        }
-                        output_page->loadPair(probe_record, hash_record);  // Write matched pair
-                    }
-                }
-            }
+        if (before_bucket) {
+            before_bucket();
         }
-
-	//reset hash table in prepation for the next partition
-	for(uint mem_page = 0; mem_page < MEM_SIZE_IN_PAGE - 2; ++mem_page)
-	{
-		mem->mem_page(mem_page)->reset();
-	}
-
+        probe_bucket(disk, mem, bucket, left_size <= right_size, mem->size() - 2,
+                     write_pair);
     }
 
 	// Flush any remaining output pages in memory
-    Page* final_output_page = mem->mem_page(MEM_SIZE_IN_PAGE - 1);
+    Page* final_output_page = mem->mem_page(mem->size() - 1);
     if (!final_output_page->empty()) {
-        uint flushed_page_id = mem->flushToDisk(disk, MEM_SIZE_IN_PAGE - 1);
+        uint flushed_page_id = mem->flushToDisk(disk, mem->size() - 1);
         disk_pages.push_back(flushed_page_id);
     }
 
@@ -203,20 +243,20 @@ vector<uint> probe(Disk* disk, Mem* mem, vector<Bucket>& partitions) {
 		3. for each page in smaller relation:
 			1. load page from disk to memory
 			2. for each tuple in page:
-				1. hash tuple key (use modulo MEM_SIZE_IN_PAGE - 2)
+				1. hash tuple key (use modulo mem->size() - 2)
 				2. load tuple into page with the hashed page_id
 			3. flush input buffer to disk
 		4. for each page in bigger relation:
 			1. load page from disk to memory
 			2. for each tuple in page:
-				1. hash tuple key (use modulo MEM_SIZE_IN_PAGE - 2)
+				1. hash tuple key (use modulo mem->size() - 2)
 				2. for each tuple in hashed bucket:
 					1. if tuple in bigger relation's page is equal to tuple in hashed bucket:
 						1. if output buffer is full
 							1. flush output buffer to disk, while pushing the returned disk page id to 
 							   disk_pages
 						2. load pair into output buffer
-		5. for memory page with id < MEM_SIZE_IN_PAGE - 2:
+		5. for memory page with id < mem->size() - 2:
 					1. if bucket is not full, flush to disk
 			3. flush input buffer to disk
 	
@@ -7,6 +7,8 @@
 #include "Bucket.hpp"
 #include "Mem.hpp"
 
+#include <functional>
+
 /*
  * partition function
  *
@@ -17,7 +19,7 @@
  * right_rel: [right_rel.first, right_rel.second) will be the range of page ids of right relation to join
  *
  * Output:
- * A vector of buckets of size (MEM_SIZE_IN_PAGE - 1).
+ * A vector of buckets of size (mem->size() - 1).
  * Each bucket represent a partition of both relation.
  * See Bucket class for more information.
 */
@@ -25,16 +27,69 @@ std::vector<Bucket> partition(Disk* disk, Mem* mem,
                               std::pair<uint, uint> left_rel,
                               std::pair<uint, uint> right_rel);
 
+/*
+ * partition_left function
+ *
+ * Input:
+ * disk: pointer of Disk object
+ * mem: pointer of Memory object
+ * left_rel: [left_rel.first, left_rel.second) will be the range of page ids of the relation to partition
+ *
+ * Output:
+ * A vector of buckets of size (mem->size() - 1) holding only the left relation.
+*/
+std::vector<Bucket> partition_left(Disk* disk, Mem* mem,
+                                   std::pair<uint, uint> left_rel);
+
+/*
+ * partition_right function
+ *
+ * Input:
+ * disk: pointer of Disk object
+ * mem: pointer of Memory object
+ * partitions: buckets that already hold the left relation, e.g. from load_partitions()
+ * right_rel: [right_rel.first, right_rel.second) will be the range of page ids of right relation to join
+ *
+ * The right relation is hashed with the fanout partitions.size(), which must
+ * not exceed mem->size() - 1.
+*/
+void partition_right(Disk* disk, Mem* mem, std::vector<Bucket>& partitions,
+                     std::pair<uint, uint> right_rel);
+
+/*
+ * probe_bucket function
+ *
+ * Input:
+ * disk: pointer of Disk object
+ * mem: pointer of Memory object
+ * bucket: a reference to the bucket to join
+ * build_is_left: build the hash table from the left relation of the bucket instead of the right one
+ * table_size: the hash table spans memory pages [0, table_size), page mem->size() - 2 is the input buffer
+ * on_match: called with the left record and the right record of every matching pair
+ *
+ * When the build relation overflows a hash page, the bucket is joined in
+ * several passes, each over a chunk of the build relation that fits.
+*/
+void probe_bucket(Disk* disk, Mem* mem, Bucket& bucket, bool build_is_left,
+                  uint table_size,
+                  const std::function<void(const Record&, const Record&)>& on_match);
+
 /*
  * probe function
  * Input:
  * disk: pointer of Disk object
  * mem: pointer of Memory object
  * partition: a reference to a vector of buckets from partition function
+ * before_bucket: if set, called before each bucket is joined; it may shrink mem
+ *
+ * The hash table of each bucket spans mem->size() - 2 pages, so mem must
+ * have at least 3 pages.
  *
  * Output:
  * A vector of page ids that contains the join result.
+ * Each matching pair is stored as the left record followed by the right record.
 */
-std::vector<uint> probe(Disk* disk, Mem* mem, std::vector<Bucket>& partition);
+std::vector<uint> probe(Disk* disk, Mem* mem, std::vector<Bucket>& partition,
+                        const std::function<void()>& before_bucket = nullptr);
 
 #endif
@@ -5,10 +5,10 @@
 using namespace std;
 
 /* RAII paradigm */
-Mem::Mem() {
+Mem::Mem(uint _size_in_page, uint records_per_page) {
 	/* Dynamic memory allocation for memory page */
-	for (uint i = 0; i < MEM_SIZE_IN_PAGE; ++i) {
-		pages.push_back(make_shared<Page>());
+	for (uint i = 0; i < _size_in_page; ++i) {
+		pages.push_back(make_shared<Page>(records_per_page));
 	}
 }
 
@@ -18,6 +18,15 @@ Mem::~Mem() {
 	}
 }
 
+uint Mem::size() const { return pages.size(); }
+
+void Mem::shrink(uint size_in_page) {
+	if (size_in_page >= 2 && size_in_page < pages.size()) {
+		pages.erase(pages.end() - 2 - (pages.size() - size_in_page),
+		            pages.end() - 2);
+	}
+}
+
 void Mem::reset() {
 	for (auto& page : pages) {
 		page->reset();
@@ -40,7 +49,7 @@ uint Mem::flushToDisk(Disk* d, uint mem_page_id) {
 }
 
 void Mem::print() {
-	for (uint i = 0; i < MEM_SIZE_IN_PAGE; i++) {
+	for (uint i = 0; i < pages.size(); i++) {
 		cout << "PageID " << i << " in Mem:" << endl;
 		if (pages[i]) {
 			pages[i]->print();
@@ -10,10 +10,22 @@
 
 class Mem {
 public:
-	Mem();
+	/* Allocate _size_in_page pages, each holding records_per_page records */
+	explicit Mem(uint _size_in_page = MEM_SIZE_IN_PAGE,
+	             uint records_per_page = RECORDS_PER_PAGE);
 
 	~Mem();
 
+	/* Return number of pages in memory */
+	uint size() const;
+
+	/*
+     * Release memory pages so that size_in_page (at least 2) remain.
+     * The last two pages, the input and output buffers of probe, are kept
+     * with their records; the released pages before them must be empty.
+     */
+	void shrink(uint size_in_page);
+
 	/* reset all memory pages */
 	void reset();
 
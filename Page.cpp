@@ -4,22 +4,30 @@
 
 using namespace std;
 
-Page::Page() = default;
+Page::Page(uint _capacity) : max_records(_capacity) {}
 
-Page::Page(const Page& other) { loadPage(&other); }
+Page::Page(const Page& other) : max_records(other.max_records) {
+	loadPage(&other);
+}
 
 uint Page::size() { return records.size(); }
 
+uint Page::capacity() { return max_records; }
+
 bool Page::empty() { return records.empty(); }
 
-bool Page::full() { return records.size() == RECORDS_PER_PAGE; }
+bool Page::full() { return records.size() == max_records; }
 
 void Page::reset() { records.clear(); }
 
-Record Page::get_record(uint record_id) { return records[record_id]; }
+const Record& Page::get_record(uint record_id) { return records[record_id]; }
+
+void Page::set_record(uint record_id, const Record& r) {
+	records[record_id] = r;
+}
 
 void Page::loadRecord(const Record& r) {
-	if (records.size() < RECORDS_PER_PAGE) {
+	if (records.size() < max_records) {
 		records.emplace_back(r);
 	} else {
 		cout << "Error: Can not add record into full page." << endl;
@@ -30,7 +38,7 @@ void Page::loadRecord(const Record& r) {
 // load 2 matching record into a page
 // records per page will always be even number
 void Page::loadPair(const Record& left_r, const Record& right_r) {
-	if (records.size() >= RECORDS_PER_PAGE - 1) {
+	if (records.size() >= max_records - 1) {
 		cout << "Error: Can not add record into full page." << endl;
 		exit(1);
 	}
@@ -39,6 +47,10 @@ void Page::loadPair(const Record& left_r, const Record& right_r) {
 }
 
 void Page::loadPage(const Page* p2) {
+	if (p2->records.size() > max_records) {
+		cout << "Error: Can not load page into a smaller page." << endl;
+		exit(1);
+	}
 	reset();
 	for (const auto& record : p2->records) {
 		records.emplace_back(record);
@@ -12,7 +12,8 @@
 
 class Page {
 public:
-	Page();
+	/* Create an empty page that holds at most _capacity records */
+	explicit Page(uint _capacity = RECORDS_PER_PAGE);
 
 	/* Copy constructor */
 	Page(const Page& other);
@@ -20,6 +21,9 @@ public:
 	/* Return number of records in this page */
 	uint size();
 
+	/* Return the maximum number of records this page can hold */
+	uint capacity();
+
 	/* Return true if this page is empty */
 	bool empty();
 
@@ -30,7 +34,10 @@ public:
 	void reset();
 
 	/* Get the specific record in this->records at position record_id */
-	Record get_record(uint record_id);
+	const Record& get_record(uint record_id);
+
+	/* Replace the record in this->records at position record_id */
+	void set_record(uint record_id, const Record& r);
 
 	/* Load single record into the page */
 	void loadRecord(const Record& r);
@@ -49,6 +56,8 @@ public:
 
 private:
 	std::vector<Record> records;
+
+	uint max_records;
 };
 
 #endif
\ No newline at end of file
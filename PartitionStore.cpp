@@ -0,0 +1,141 @@
+#include "PartitionStore.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+#define PARTITION_FILE_MAGIC "GHJPART1"
+#define PARTITION_FILE_MAGIC_LEN 8
+
+/*
+ * partition_hash() of this key is stored in the file, so a build with a
+ * different hash function refuses to reuse the partitions
+ */
+#define HASH_CHECK_KEY "ghj-partition-hash-check"
+
+static uint hash_check() {
+	return Record(HASH_CHECK_KEY, "").partition_hash();
+}
+
+static void write_uint(ofstream& out, uint value) {
+	uint32_t v = value;
+	out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+static void write_string(ofstream& out, const string& str) {
+	write_uint(out, str.size());
+	out.write(str.data(), str.size());
+}
+
+static void read_error(const char* filename) {
+	cerr << "Error: " << filename << " is not a valid partition file." << endl;
+	exit(1);
+}
+
+static uint read_uint(ifstream& in, const char* filename) {
+	uint32_t v = 0;
+	if (!in.read(reinterpret_cast<char*>(&v), sizeof(v))) {
+		read_error(filename);
+	}
+	return v;
+}
+
+/* A length larger than the whole file can only come from a corrupt file */
+static string read_string(ifstream& in, const char* filename,
+                          uint64_t file_size) {
+	uint size = read_uint(in, filename);
+	if (size > file_size) {
+		read_error(filename);
+	}
+	string str(size, '\0');
+	if (!in.read(&str[0], str.size())) {
+		read_error(filename);
+	}
+	return str;
+}
+
+void save_partitions(const char* filename, Disk* disk,
+                     vector<Bucket>& partitions) {
+	ofstream out(filename, ios::binary | ios::trunc);
+	if (!out) {
+		cerr << "Error: can not open " << filename << " for writing." << endl;
+		exit(1);
+	}
+	out.write(PARTITION_FILE_MAGIC, PARTITION_FILE_MAGIC_LEN);
+	write_uint(out, disk->page_capacity());
+	write_uint(out, partitions.size());
+	write_uint(out, hash_check());
+	for (Bucket& bucket : partitions) {
+		vector<uint> left_rel = bucket.get_left_rel();
+		write_uint(out, bucket.num_left_rel_record);
+		write_uint(out, left_rel.size());
+		for (uint page_id : left_rel) {
+			Page* page = disk->diskRead(page_id);
+			write_uint(out, page->size());
+			for (uint r = 0; r < page->size(); ++r) {
+				Record record = page->get_record(r);
+				write_string(out, record.get_key());
+				write_string(out, record.get_data());
+			}
+		}
+	}
+	out.close();
+	if (!out) {
+		cerr << "Error: failed to write " << filename << "." << endl;
+		exit(1);
+	}
+}
+
+vector<Bucket> load_partitions(const char* filename, Disk* disk) {
+	ifstream in(filename, ios::binary);
+	if (!in) {
+		cerr << "Error: can not open " << filename << " for reading." << endl;
+		exit(1);
+	}
+	in.seekg(0, ios::end);
+	uint64_t file_size = in.tellg();
+	in.seekg(0, ios::beg);
+	char magic[PARTITION_FILE_MAGIC_LEN];
+	if (!in.read(magic, PARTITION_FILE_MAGIC_LEN)
+	    || string(magic, PARTITION_FILE_MAGIC_LEN) != PARTITION_FILE_MAGIC) {
+		read_error(filename);
+	}
+	uint records_per_page = read_uint(in, filename);
+	uint fanout = read_uint(in, filename);
+	if (read_uint(in, filename) != hash_check()) {
+		cerr << "Error: " << filename
+		     << " was partitioned with a different hash function." << endl;
+		exit(1);
+	}
+	if (records_per_page > disk->page_capacity()) {
+		cerr << "Error: " << filename << " has pages of " << records_per_page
+		     << " records, larger than the disk page size." << endl;
+		exit(1);
+	}
+
+	vector<Bucket> partitions(fanout, Bucket(disk));
+	for (Bucket& bucket : partitions) {
+		uint num_records = read_uint(in, filename);
+		uint num_pages = read_uint(in, filename);
+		for (uint p = 0; p < num_pages; ++p) {
+			uint page_size = read_uint(in, filename);
+			if (page_size > records_per_page) {
+				read_error(filename);
+			}
+			shared_ptr<Page> page = make_shared<Page>(disk->page_capacity());
+			for (uint r = 0; r < page_size; ++r) {
+				string key = read_string(in, filename, file_size);
+				string data = read_string(in, filename, file_size);
+				page->loadRecord(Record(key, data));
+			}
+			bucket.add_left_rel_page(disk->diskWrite(page));
+		}
+		/* add_left_rel_page() recounts the records from the loaded pages */
+		if (bucket.num_left_rel_record != num_records) {
+			read_error(filename);
+		}
+	}
+	return partitions;
+}
@@ -0,0 +1,37 @@
+/*
+ * This file defines functions to persist the partitioned left relation, so
+ * repeated joins against the same build relation only partition the right one
+ */
+#ifndef _PARTITION_STORE_HPP_
+#define _PARTITION_STORE_HPP_
+
+#include "Bucket.hpp"
+
+/*
+ * save_partitions function
+ *
+ * Input:
+ * filename: file to write
+ * disk: pointer of Disk object holding the bucket pages
+ * partitions: a reference to a vector of buckets from partition function
+ *
+ * Writes the fanout, page size, a check value of partition_hash() and, for
+ * every bucket, its left relation record count and pages.
+ * The right relation of the buckets is not saved.
+*/
+void save_partitions(const char* filename, Disk* disk,
+                     std::vector<Bucket>& partitions);
+
+/*
+ * load_partitions function
+ *
+ * Input:
+ * filename: file written by save_partitions
+ * disk: pointer of Disk object to copy the bucket pages into
+ *
+ * Output:
+ * A vector of buckets holding only the left relation, ready for partition_right.
+*/
+std::vector<Bucket> load_partitions(const char* filename, Disk* disk);
+
+#endif
@@ -16,6 +16,12 @@ Record::Record(const Record& other) {
 	data = other.data;
 }
 
+Record& Record::operator=(const Record& other) {
+	key = other.key;
+	data = other.data;
+	return *this;
+}
+
 /* h1 used at partition stage */
 uint Record::partition_hash() {
 	/* Use stl hash function */
@@ -30,21 +36,24 @@ uint Record::probe_hash() {
 	return str_hash("key:" + key) % MODULAR;
 }
 
-/* Equality comparator */
-bool Record::operator==(const Record& rhs) const {
+/* h3 independent of h1 and h2, so each shard still uses every bucket */
+uint Record::shard_hash() {
+	/* Use stl hash function */
 	hash<string> str_hash;
-	/* If two records have different hash values(h2) of key, exit */
-	if ((uint) (str_hash("key:" + key) % MODULAR) % (MEM_SIZE_IN_PAGE - 2)
-	    != (uint) (str_hash("key:" + rhs.key) % MODULAR)
-	            % (MEM_SIZE_IN_PAGE - 2)) {
-		cout << "Error: Can not compare two records with different hash "
-		        "values(rhs) of key."
-		     << endl;
-		exit(1);
-	}
-	return key == rhs.key;
+	return str_hash("shard:" + key) % MODULAR;
 }
 
+/* Equality comparator */
+/*
+ * The hash table size now depends on the Mem a join runs with, so the probe
+ * phase is responsible for only comparing records from the same hash page.
+ */
+bool Record::operator==(const Record& rhs) const { return key == rhs.key; }
+
+const string& Record::get_key() const { return key; }
+
+const string& Record::get_data() const { return data; }
+
 void Record::print() {
 	cout << "Record with key=" << key << " and data=" << data << "\n";
 }
@@ -17,15 +17,27 @@ public:
 	/* Copy constructor */
 	Record(const Record& other);
 
+	/* Copy assignment */
+	Record& operator=(const Record& other);
+
 	/* Hash value of key in the partition phase */
 	uint partition_hash();
 
 	/* Hash value of key in the probe phase*/
 	uint probe_hash();
 
+	/* Hash value of key used to route records to shards */
+	uint shard_hash();
+
 	/* Equality comparator */
 	bool operator==(const Record& rhs) const;
 
+	/* Key of this record */
+	const std::string& get_key() const;
+
+	/* Data of this record */
+	const std::string& get_data() const;
+
 	/* Print the key and data with in record*/
 	void print();
 
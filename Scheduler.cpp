@@ -0,0 +1,152 @@
+#include "Scheduler.hpp"
+
+#include "Join.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+/* One input buffer, one output buffer and one hash table page */
+#define MIN_GRANT_IN_PAGE 3u
+
+Scheduler::Scheduler(Disk* _disk, uint _budget_in_page)
+    : disk(_disk), budget_in_page(_budget_in_page),
+      free_pages(_budget_in_page) {
+	if (budget_in_page < MIN_GRANT_IN_PAGE) {
+		cerr << "Error: memory budget must be at least " << MIN_GRANT_IN_PAGE
+		     << " pages." << endl;
+		exit(1);
+	}
+}
+
+Scheduler::~Scheduler() { wait_all(); }
+
+uint Scheduler::submit(pair<uint, uint> left_rel, pair<uint, uint> right_rel,
+                       uint mem_pages) {
+	lock_guard<mutex> lock(queries_mutex);
+	uint query_id = queries.size();
+	queries.emplace_back(new Query());
+	Query& query = *queries.back();
+	query.left_rel = left_rel;
+	query.right_rel = right_rel;
+	query.grant_in_page = min(max(mem_pages, MIN_GRANT_IN_PAGE), budget_in_page);
+	query.target_in_page = query.grant_in_page;
+	waiting.push_back(query_id);
+	threads.emplace_back(&Scheduler::run, this, query_id);
+	return query_id;
+}
+
+bool Scheduler::shrink_grant(uint query_id, uint mem_pages) {
+	lock_guard<mutex> lock(queries_mutex);
+	Query& query = *queries[query_id];
+	mem_pages = max(mem_pages, MIN_GRANT_IN_PAGE);
+	if (query.state == QueryState::QUEUED) {
+		query.grant_in_page = min(query.grant_in_page, mem_pages);
+		/* The query may fit in the free pages now */
+		budget_freed.notify_all();
+	} else if (query.state == QueryState::RUNNING) {
+		/* Applied by run() before the next bucket is probed */
+		query.target_in_page = min(query.target_in_page, mem_pages);
+	}
+	return query.state != QueryState::DONE;
+}
+
+void Scheduler::on_admit(function<void(uint)> hook) {
+	lock_guard<mutex> lock(queries_mutex);
+	admit_hook = hook;
+}
+
+bool Scheduler::admitted(uint query_id) {
+	lock_guard<mutex> lock(queries_mutex);
+	return queries[query_id]->state != QueryState::QUEUED;
+}
+
+void Scheduler::wait_all() {
+	/* Take the threads under the lock, as submit() may add more meanwhile */
+	while (true) {
+		vector<thread> submitted;
+		{
+			lock_guard<mutex> lock(queries_mutex);
+			if (threads.empty()) {
+				return;
+			}
+			submitted.swap(threads);
+		}
+		for (thread& t : submitted) {
+			t.join();
+		}
+	}
+}
+
+QueryStats Scheduler::stats(uint query_id) {
+	lock_guard<mutex> lock(queries_mutex);
+	return queries[query_id]->stats;
+}
+
+Scheduler::Query* Scheduler::admit(uint query_id) {
+	unique_lock<mutex> lock(queries_mutex);
+	Query* query = queries[query_id].get();
+	budget_freed.wait(lock, [&] {
+		return waiting.front() == query_id && query->grant_in_page <= free_pages;
+	});
+	waiting.pop_front();
+	free_pages -= query->grant_in_page;
+	query->state = QueryState::RUNNING;
+	query->target_in_page = query->grant_in_page;
+	/* The next query in line may fit in what is left */
+	budget_freed.notify_all();
+	return query;
+}
+
+void Scheduler::release(uint pages) {
+	lock_guard<mutex> lock(queries_mutex);
+	free_pages += pages;
+	budget_freed.notify_all();
+}
+
+void Scheduler::run(uint query_id) {
+	Query* query = admit(query_id);
+	uint grant = query->grant_in_page;
+	function<void(uint)> hook;
+	{
+		lock_guard<mutex> lock(queries_mutex);
+		hook = admit_hook;
+	}
+	if (hook) {
+		hook(query_id);
+	}
+
+	/* Each query owns its Mem, sized by its grant */
+	Mem mem(grant, disk->page_capacity());
+	vector<Bucket> res = partition(disk, &mem, query->left_rel, query->right_rel);
+
+	/*
+	 * The fanout is fixed now, but each bucket of the probe phase can run in
+	 * fewer pages, its hash table being empty in between
+	 */
+	auto apply_shrink = [&]() {
+		uint target;
+		{
+			lock_guard<mutex> lock(queries_mutex);
+			target = query->target_in_page;
+			query->grant_in_page = min(query->grant_in_page, target);
+		}
+		if (target < grant) {
+			mem.shrink(target);
+			release(grant - target);
+			grant = target;
+		}
+	};
+	vector<uint> join_res = probe(disk, &mem, res, apply_shrink);
+
+	{
+		lock_guard<mutex> lock(queries_mutex);
+		query->state = QueryState::DONE;
+		query->stats.grant_in_page = grant;
+		query->stats.load_from_disk = mem.loadFromDiskTimes();
+		query->stats.flush_to_disk = mem.flushToDiskTimes();
+		query->stats.join_res = join_res;
+	}
+	release(grant);
+}
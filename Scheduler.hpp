@@ -0,0 +1,115 @@
+/*
+ * This file defines the query scheduler, which runs several joins
+ * concurrently against one shared Disk and one global memory budget
+ */
+#ifndef _SCHEDULER_HPP_
+#define _SCHEDULER_HPP_
+
+#include "Disk.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/* Result and I/O counters of a finished query */
+struct QueryStats {
+	// number of memory pages the query finished with
+	uint grant_in_page = 0;
+
+	// number of Mem::loadFromDisk and Mem::flushToDisk calls of the query
+	size_t load_from_disk = 0;
+	size_t flush_to_disk = 0;
+
+	// disk page ids of the join result
+	std::vector<uint> join_res;
+};
+
+class Scheduler {
+public:
+	/* Queries spill to _disk and share _budget_in_page memory pages */
+	Scheduler(Disk* _disk, uint _budget_in_page);
+
+	/* Waits for all submitted queries */
+	~Scheduler();
+
+	/*
+	 * Queue a join of left_rel and right_rel asking for mem_pages memory pages,
+	 * capped at the budget. Queries are admitted in submission order once
+	 * enough of the budget is free. Return the query id.
+	 */
+	uint submit(std::pair<uint, uint> left_rel, std::pair<uint, uint> right_rel,
+	            uint mem_pages);
+
+	/*
+	 * Lower the grant of a query to mem_pages, at least 3.
+	 * A queued query is admitted with the smaller grant. A running query
+	 * keeps its partition fanout, and applies the shrink before the next
+	 * bucket it probes: the pages go back to the budget and the remaining
+	 * buckets are joined in more passes. A shrink that arrives while the
+	 * last bucket is probed has no effect.
+	 * Return false if the query has already finished. QueryStats reports the
+	 * grant the query finished with.
+	 */
+	bool shrink_grant(uint query_id, uint mem_pages);
+
+	/*
+	 * Call hook with the query id on the thread of every admitted query,
+	 * before its partition phase and while it holds its grant.
+	 * Set it before submitting queries.
+	 */
+	void on_admit(std::function<void(uint)> hook);
+
+	/* Return true once query_id has been admitted */
+	bool admitted(uint query_id);
+
+	/*
+	 * Block until every submitted query has finished, including queries
+	 * submitted from other threads while waiting
+	 */
+	void wait_all();
+
+	/* Statistics of a query, valid after wait_all() */
+	QueryStats stats(uint query_id);
+
+private:
+	enum class QueryState { QUEUED, RUNNING, DONE };
+
+	struct Query {
+		std::pair<uint, uint> left_rel;
+		std::pair<uint, uint> right_rel;
+		QueryState state = QueryState::QUEUED;
+		// pages the query asks for, or holds once running
+		uint grant_in_page = 0;
+		// pages a running query was asked to shrink to
+		uint target_in_page = 0;
+		QueryStats stats;
+	};
+
+	/* Body of the thread running query_id */
+	void run(uint query_id);
+
+	/* Wait until query_id is admitted and return it */
+	Query* admit(uint query_id);
+
+	/* Give pages back to the budget */
+	void release(uint pages);
+
+	Disk* disk;
+	uint budget_in_page;
+	uint free_pages;
+
+	std::vector<std::unique_ptr<Query>> queries;
+	std::vector<std::thread> threads;
+	// ids of queries waiting for admission, in submission order
+	std::deque<uint> waiting;
+
+	std::function<void(uint)> admit_hook;
+
+	// Guards free_pages, queries, threads and waiting
+	std::mutex queries_mutex;
+	std::condition_variable budget_freed;
+};
+
+#endif
@@ -0,0 +1,274 @@
+#include "Shard.hpp"
+
+#include "Join.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+/* Marks the end of a relation or of the result stream */
+#define END_OF_STREAM 0xffffffffu
+
+/* Bytes buffered per shard before they are sent */
+#define SEND_BUFFER_SIZE 65536
+
+/*
+ * Buffered writer over a socket.
+ * Every record is sent as the length and bytes of its key, then of its data.
+ */
+class ShardWriter {
+public:
+	explicit ShardWriter(int _fd) : fd(_fd) {}
+
+	void put_uint(uint value) {
+		uint32_t v = value;
+		buf.append(reinterpret_cast<const char*>(&v), sizeof(v));
+		if (buf.size() >= SEND_BUFFER_SIZE) {
+			flush();
+		}
+	}
+
+	void put_record(const Record& r) {
+		put_string(r.get_key());
+		put_string(r.get_data());
+	}
+
+	void flush() {
+		size_t sent = 0;
+		while (sent < buf.size()) {
+			ssize_t n = send(fd, buf.data() + sent, buf.size() - sent, MSG_NOSIGNAL);
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n <= 0) {
+				cerr << "Error: lost connection to shard." << endl;
+				exit(1);
+			}
+			sent += n;
+		}
+		buf.clear();
+	}
+
+private:
+	void put_string(const string& str) {
+		put_uint(str.size());
+		buf.append(str);
+		if (buf.size() >= SEND_BUFFER_SIZE) {
+			flush();
+		}
+	}
+
+	int fd;
+	string buf;
+};
+
+/* Buffered reader over a socket, the counterpart of ShardWriter */
+class ShardReader {
+public:
+	explicit ShardReader(int _fd) : fd(_fd), buf(SEND_BUFFER_SIZE) {}
+
+	uint get_uint() {
+		uint32_t v = 0;
+		get(reinterpret_cast<char*>(&v), sizeof(v));
+		return v;
+	}
+
+	/* Return false at the end of stream marker instead of a record */
+	bool get_record(string& key, string& data) {
+		uint key_size = get_uint();
+		if (key_size == END_OF_STREAM) {
+			return false;
+		}
+		key.resize(key_size);
+		get(&key[0], key_size);
+		data.resize(get_uint());
+		get(&data[0], data.size());
+		return true;
+	}
+
+private:
+	void get(char* dst, size_t n) {
+		while (n > 0) {
+			if (pos == len) {
+				ssize_t got = recv(fd, buf.data(), buf.size(), 0);
+				if (got < 0 && errno == EINTR) {
+					continue;
+				}
+				if (got <= 0) {
+					cerr << "Error: lost connection to shard." << endl;
+					exit(1);
+				}
+				pos = 0;
+				len = got;
+			}
+			size_t chunk = min(n, len - pos);
+			copy(buf.data() + pos, buf.data() + pos + chunk, dst);
+			pos += chunk;
+			dst += chunk;
+			n -= chunk;
+		}
+	}
+
+	int fd;
+	vector<char> buf;
+	size_t pos = 0;
+	size_t len = 0;
+};
+
+/*
+ * Receive one relation into disk pages of the worker
+ * Return [first page id, last page id) like Disk::read_data
+ */
+static pair<uint, uint> receive_relation(ShardReader& in, Disk* disk) {
+	uint start_page_id = 0, end_page_id = 0;
+	bool first_page = true;
+	shared_ptr<Page> page = make_shared<Page>(disk->page_capacity());
+	string key, data;
+	bool more = true;
+	while (more) {
+		more = in.get_record(key, data);
+		if (more) {
+			page->loadRecord(Record(key, data));
+		}
+		if (page->full() || (!more && !page->empty())) {
+			end_page_id = disk->diskWrite(page) + 1;
+			if (first_page) {
+				start_page_id = end_page_id - 1;
+				first_page = false;
+			}
+			page->reset();
+		}
+	}
+	if (first_page) {
+		return make_pair(0, 0);
+	}
+	return make_pair(start_page_id, end_page_id);
+}
+
+/* Body of a worker process, which owns one shard */
+static void run_shard(int fd, uint records_per_page, uint mem_pages,
+                      uint disk_pages) {
+	Disk disk(disk_pages, records_per_page);
+	Mem mem(mem_pages, records_per_page);
+	ShardReader in(fd);
+	pair<uint, uint> left_rel = receive_relation(in, &disk);
+	pair<uint, uint> right_rel = receive_relation(in, &disk);
+
+	vector<Bucket> res = partition(&disk, &mem, left_rel, right_rel);
+	vector<uint> join_res = probe(&disk, &mem, res);
+
+	ShardWriter out(fd);
+	for (uint page_id : join_res) {
+		Page* page = disk.diskRead(page_id);
+		out.put_uint(page->size());
+		for (uint r = 0; r < page->size(); ++r) {
+			out.put_record(page->get_record(r));
+		}
+	}
+	out.put_uint(END_OF_STREAM);
+	out.flush();
+}
+
+/* Read a relation file and route every record to the writer of its shard */
+static void route_relation(const char* filename, vector<ShardWriter>& shards) {
+	ifstream raw_data_file(filename);
+	if (!raw_data_file) {
+		cerr << "Error: can not open " << filename << "." << endl;
+		exit(1);
+	}
+	string one_line;
+	while (getline(raw_data_file, one_line)) {
+		size_t space_idx = one_line.find(' ');
+		Record record(one_line.substr(0, space_idx), one_line.substr(space_idx + 1));
+		shards[record.shard_hash() % shards.size()].put_record(record);
+	}
+	for (ShardWriter& shard : shards) {
+		shard.put_uint(END_OF_STREAM);
+	}
+}
+
+vector<uint> sharded_join(Disk* disk, const char* left_file,
+                          const char* right_file, uint num_shards,
+                          uint mem_pages, uint disk_pages) {
+	/* fds[i][0] is kept by the coordinator, fds[i][1] by worker i */
+	vector<pair<int, int>> fds;
+	for (uint i = 0; i < num_shards; ++i) {
+		int sv[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+			cerr << "Error: can not create socket for shard " << i << "." << endl;
+			exit(1);
+		}
+		fds.emplace_back(sv[0], sv[1]);
+	}
+
+	/* Do not let workers inherit buffered output */
+	cout.flush();
+	vector<pid_t> workers;
+	for (uint i = 0; i < num_shards; ++i) {
+		pid_t pid = fork();
+		if (pid < 0) {
+			cerr << "Error: can not fork worker for shard " << i << "." << endl;
+			exit(1);
+		}
+		if (pid == 0) {
+			for (uint j = 0; j < num_shards; ++j) {
+				close(fds[j].first);
+				if (j != i) {
+					close(fds[j].second);
+				}
+			}
+			run_shard(fds[i].second, disk->page_capacity(), mem_pages, disk_pages);
+			_exit(0);
+		}
+		workers.push_back(pid);
+	}
+	for (auto& fd : fds) {
+		close(fd.second);
+	}
+
+	/* Shuffle phase: the coordinator is the loader for both relations */
+	vector<ShardWriter> shards;
+	for (auto& fd : fds) {
+		shards.emplace_back(fd.first);
+	}
+	route_relation(left_file, shards);
+	route_relation(right_file, shards);
+	for (ShardWriter& shard : shards) {
+		shard.flush();
+	}
+
+	/* Merge phase: copy the result pages of every shard into disk */
+	vector<uint> disk_pages_out;
+	shared_ptr<Page> page = make_shared<Page>(disk->page_capacity());
+	string key, data;
+	for (auto& fd : fds) {
+		ShardReader in(fd.first);
+		for (uint page_size = in.get_uint(); page_size != END_OF_STREAM;
+		     page_size = in.get_uint()) {
+			page->reset();
+			for (uint r = 0; r < page_size; ++r) {
+				in.get_record(key, data);
+				page->loadRecord(Record(key, data));
+			}
+			disk_pages_out.push_back(disk->diskWrite(page));
+		}
+		close(fd.first);
+	}
+
+	for (uint i = 0; i < num_shards; ++i) {
+		int status = 0;
+		if (waitpid(workers[i], &status, 0) < 0 || !WIFEXITED(status)
+		    || WEXITSTATUS(status) != 0) {
+			cerr << "Error: worker for shard " << i << " failed." << endl;
+			exit(1);
+		}
+	}
+	return disk_pages_out;
+}
@@ -0,0 +1,33 @@
+/*
+ * This file defines the sharded execution mode of GHJ, where worker
+ * processes each join the records whose keys hash to their shard
+ */
+#ifndef _SHARD_HPP_
+#define _SHARD_HPP_
+
+#include "Disk.hpp"
+
+/*
+ * sharded_join function
+ *
+ * Input:
+ * disk: pointer of the coordinator's Disk object, which receives the join result
+ * left_file: txt file of left relation
+ * right_file: txt file of right relation
+ * num_shards: number of worker processes to fork
+ * mem_pages: size of the Mem each worker joins with
+ * disk_pages: size of the Disk each worker spills to
+ *
+ * The coordinator reads both relations and routes each record over a Unix
+ * socket to the worker owning shard_hash() % num_shards. Every worker runs
+ * partition() and probe() on its own Disk and Mem and sends its result pages
+ * back, which are written to disk shard by shard.
+ *
+ * Output:
+ * A vector of page ids in disk that contains the join result.
+*/
+std::vector<uint> sharded_join(Disk* disk, const char* left_file,
+                               const char* right_file, uint num_shards,
+                               uint mem_pages, uint disk_pages);
+
+#endif
@@ -1,6 +1,8 @@
 /*
  * This file defines constant values used throughout GHJ part.
- * Feel free to modify the values to test different scenarios.
+ * These are the default sizes; Disk, Mem and Page take their actual sizes
+ * as constructor arguments, and the GHJ binary can override them with
+ * --page-records, --mem-pages and --disk-pages.
  */
 #ifndef _CONSTANTS_HPP_
 #define _CONSTANTS_HPP_
@@ -11,4 +13,4 @@ const uint RECORDS_PER_PAGE = 64;
 const uint MEM_SIZE_IN_PAGE = 32;
 const uint DISK_SIZE_IN_PAGE = 999;
 
-#endif
\ No newline at end of file
+#endif
@@ -1,8 +1,17 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
+#include "Aggregate.hpp"
 #include "Bucket.hpp"
+#include "ColumnarFile.hpp"
 #include "Join.hpp"
 #include "Mem.hpp"
+#include "PartitionStore.hpp"
+#include "Scheduler.hpp"
+#include "Shard.hpp"
 
 using namespace std;
 
@@ -15,26 +24,273 @@ void print(vector<uint>& join_res, Disk* disk) {
 	}
 }
 
+/* Print the rows of a columnar join result file */
+void scan(const char* filename) {
+	ColumnarReader reader(filename);
+	cout << "Size of GHJ result: " << reader.num_rows() << " rows" << endl;
+	for (uint64_t row = 0; row < reader.num_rows(); ++row) {
+		pair<const char*, size_t> left_key = reader.get(Column::LEFT_KEY, row);
+		pair<const char*, size_t> left_data = reader.get(Column::LEFT_DATA, row);
+		pair<const char*, size_t> right_key = reader.get(Column::RIGHT_KEY, row);
+		pair<const char*, size_t> right_data = reader.get(Column::RIGHT_DATA, row);
+		cout << "Row " << row << " with left key=";
+		cout.write(left_key.first, left_key.second) << " and data=";
+		cout.write(left_data.first, left_data.second) << ", right key=";
+		cout.write(right_key.first, right_key.second) << " and data=";
+		cout.write(right_data.first, right_data.second) << "\n";
+	}
+}
+
+/* Write the join result to out_file in columnar format, or print it */
+void output(vector<uint>& join_res, Disk* disk, const char* out_file) {
+	if (out_file) {
+		write_columnar(out_file, disk, join_res);
+	} else {
+		print(join_res, disk);
+	}
+}
+
+void usage() {
+	cerr << "Usage: ./GHJ [--mem-pages N] [--page-records N] [--disk-pages N] "
+	        "[--agg OP | --out FILE] [--save-build FILE] left_rel.txt right_rel.txt"
+	     << endl;
+	cerr << "       ./GHJ [--mem-pages N] [--page-records N] [--disk-pages N] "
+	        "[--agg OP | --out FILE] --load-build FILE right_rel.txt"
+	     << endl;
+	cerr << "       ./GHJ [--mem-pages N] [--page-records N] [--disk-pages N] "
+	        "--agg OP rel.txt"
+	     << endl;
+	cerr << "       ./GHJ [--mem-pages N] [--page-records N] [--disk-pages N] "
+	        "[--out FILE] --shards K left_rel.txt right_rel.txt"
+	     << endl;
+	cerr << "       ./GHJ [--mem-pages N] [--page-records N] [--disk-pages N] "
+	        "--budget N --queries queries.txt"
+	     << endl;
+	cerr << "       ./GHJ --scan FILE" << endl;
+	cerr << "--out writes the join result to FILE in columnar format, which "
+	        "--scan prints."
+	     << endl;
+	cerr << "Each line of queries.txt is \"left_rel.txt right_rel.txt "
+	        "[mem_pages]\", mem_pages defaulting to --mem-pages."
+	     << endl;
+	cerr << "OP is one of count, sum, min, max. With two relations the join "
+	        "result is aggregated by key, with one relation that relation is."
+	     << endl;
+	exit(1);
+}
+
+/* Parse the value of a numeric command line option */
+uint parse_uint(const char* option, const char* value) {
+	char* end = nullptr;
+	unsigned long parsed = strtoul(value, &end, 10);
+	if (*value == '\0' || *end != '\0' || parsed == 0 || parsed > 0xffffffffUL) {
+		cerr << "Error: " << option << " expects a positive integer." << endl;
+		usage();
+	}
+	return (uint) parsed;
+}
+
+/*
+ * Run every join listed in queries_file concurrently on one disk, sharing
+ * budget memory pages, and print each result with its I/O counters
+ */
+void run_queries(Disk* disk, const char* queries_file, uint budget,
+                 uint mem_pages) {
+	ifstream queries(queries_file);
+	if (!queries) {
+		cerr << "Error: can not open " << queries_file << "." << endl;
+		exit(1);
+	}
+	vector<pair<string, string>> rel_files;
+	vector<pair<pair<uint, uint>, pair<uint, uint>>> rels;
+	vector<uint> query_pages;
+	string one_line;
+	while (getline(queries, one_line)) {
+		istringstream fields(one_line);
+		string left_file, right_file, pages;
+		if (!(fields >> left_file)) {
+			continue;
+		}
+		if (!(fields >> right_file)) {
+			cerr << "Error: query \"" << one_line << "\" needs two relations."
+			     << endl;
+			exit(1);
+		}
+		query_pages.push_back(fields >> pages ? parse_uint("mem_pages", pages.c_str())
+		                                      : mem_pages);
+		rel_files.emplace_back(left_file, right_file);
+		rels.emplace_back(disk->read_data(left_file.c_str()),
+		                  disk->read_data(right_file.c_str()));
+	}
+
+	Scheduler scheduler(disk, budget);
+	for (uint i = 0; i < rels.size(); ++i) {
+		scheduler.submit(rels[i].first, rels[i].second, query_pages[i]);
+	}
+	scheduler.wait_all();
+
+	for (uint i = 0; i < rels.size(); ++i) {
+		QueryStats stats = scheduler.stats(i);
+		cout << "Query " << i << ": " << rel_files[i].first << " "
+		     << rel_files[i].second << endl;
+		cout << "Granted " << stats.grant_in_page << " memory pages, "
+		     << stats.load_from_disk << " loads from disk, "
+		     << stats.flush_to_disk << " flushes to disk" << endl;
+		print(stats.join_res, disk);
+	}
+}
+
 int main(int argc, char** argv) {
 	/* Parse cmd arguments */
-	if (argc != 3) {
+	uint mem_pages = MEM_SIZE_IN_PAGE;
+	uint page_records = RECORDS_PER_PAGE;
+	uint disk_pages = DISK_SIZE_IN_PAGE;
+	const char* save_build = nullptr;
+	const char* load_build = nullptr;
+	uint shards = 0;
+	uint budget = 0;
+	const char* queries_file = nullptr;
+	const char* out_file = nullptr;
+	const char* scan_file = nullptr;
+	bool agg = false;
+	AggOp agg_op = AggOp::COUNT;
+	vector<const char*> rel_files;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--mem-pages") == 0 && i + 1 < argc) {
+			mem_pages = parse_uint(argv[i], argv[i + 1]);
+			++i;
+		} else if (strcmp(argv[i], "--page-records") == 0 && i + 1 < argc) {
+			page_records = parse_uint(argv[i], argv[i + 1]);
+			++i;
+		} else if (strcmp(argv[i], "--disk-pages") == 0 && i + 1 < argc) {
+			disk_pages = parse_uint(argv[i], argv[i + 1]);
+			++i;
+		} else if (strcmp(argv[i], "--save-build") == 0 && i + 1 < argc) {
+			save_build = argv[++i];
+		} else if (strcmp(argv[i], "--load-build") == 0 && i + 1 < argc) {
+			load_build = argv[++i];
+		} else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+			shards = parse_uint(argv[i], argv[i + 1]);
+			++i;
+		} else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+			budget = parse_uint(argv[i], argv[i + 1]);
+			++i;
+		} else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+			queries_file = argv[++i];
+		} else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			out_file = argv[++i];
+		} else if (strcmp(argv[i], "--scan") == 0 && i + 1 < argc) {
+			scan_file = argv[++i];
+		} else if (strcmp(argv[i], "--agg") == 0 && i + 1 < argc) {
+			agg = true;
+			agg_op = parse_agg_op(argv[++i]);
+		} else if (strncmp(argv[i], "--", 2) == 0) {
+			cerr << "Error: Unknown option " << argv[i] << "." << endl;
+			usage();
+		} else {
+			rel_files.push_back(argv[i]);
+		}
+	}
+	if (scan_file) {
+		if (argc != 3) {
+			cerr << "Error: --scan can not be combined with other options."
+			     << endl;
+			usage();
+		}
+		scan(scan_file);
+		return 0;
+	}
+	if (out_file && (agg || queries_file)) {
+		cerr << "Error: --out can not be combined with --agg or --queries."
+		     << endl;
+		usage();
+	}
+	if (save_build && load_build) {
+		cerr << "Error: --save-build and --load-build can not be combined."
+		     << endl;
+		usage();
+	}
+	if (queries_file) {
+		if (!budget || shards || save_build || load_build || agg
+		    || !rel_files.empty()) {
+			cerr << "Error: --queries needs --budget and no relations or "
+			        "other modes."
+			     << endl;
+			usage();
+		}
+	} else if (budget) {
+		cerr << "Error: --budget needs --queries." << endl;
+		usage();
+	}
+	if (shards && (save_build || load_build || agg)) {
+		cerr << "Error: --shards can not be combined with --save-build, "
+		        "--load-build or --agg."
+		     << endl;
+		usage();
+	}
+	/* Aggregating a single relation instead of a join */
+	bool agg_rel = agg && !load_build && !save_build && rel_files.size() == 1;
+	if (!queries_file && !agg_rel
+	    && rel_files.size() != (load_build ? 1u : 2u)) {
 		cerr << "Error: Wrong command line usage." << endl;
-		cerr << "Usage: ./GHJ left_rel.txt right_rel.txt" << endl;
-		exit(1);
+		usage();
+	}
+	/* One input buffer, one output buffer and at least one hash table page */
+	if (mem_pages < 3) {
+		cerr << "Error: --mem-pages must be at least 3." << endl;
+		usage();
+	}
+	/* Join output pages are filled with pairs of records */
+	if (page_records % 2 != 0) {
+		cerr << "Error: --page-records must be even." << endl;
+		usage();
 	}
 
 	/* Variable initialization */
-	Disk disk;
-	Mem mem;
-	pair<uint, uint> left_rel = disk.read_data(argv[1]);
-	pair<uint, uint> right_rel = disk.read_data(argv[2]);
+	Disk disk(disk_pages, page_records);
+	Mem mem(mem_pages, page_records);
+
+	if (queries_file) {
+		run_queries(&disk, queries_file, budget, mem_pages);
+		return 0;
+	}
+
+	if (shards) {
+		/* Each worker gets its own Disk and Mem of the configured sizes */
+		vector<uint> join_res = sharded_join(&disk, rel_files[0], rel_files[1],
+		                                     shards, mem_pages, disk_pages);
+		output(join_res, &disk, out_file);
+		return 0;
+	}
+
+	if (agg_rel) {
+		pair<uint, uint> rel = disk.read_data(rel_files[0]);
+		vector<uint> agg_res = aggregate(&disk, &mem, rel, agg_op);
+		print(agg_res, &disk);
+		return 0;
+	}
+
+	vector<Bucket> res;
 
 	/* Grace Hash Join Partition Phase */
-	vector<Bucket> res = partition(&disk, &mem, left_rel, right_rel);
+	if (load_build) {
+		/* The left relation was partitioned by an earlier run */
+		res = load_partitions(load_build, &disk);
+		pair<uint, uint> right_rel = disk.read_data(rel_files[0]);
+		partition_right(&disk, &mem, res, right_rel);
+	} else {
+		pair<uint, uint> left_rel = disk.read_data(rel_files[0]);
+		pair<uint, uint> right_rel = disk.read_data(rel_files[1]);
+		res = partition(&disk, &mem, left_rel, right_rel);
+		if (save_build) {
+			save_partitions(save_build, &disk, res);
+		}
+	}
 
 	/* Grace Hash Join Probe Phase */
-	vector<uint> join_res = probe(&disk, &mem, res);
+	vector<uint> join_res = agg ? probe_aggregate(&disk, &mem, res, agg_op)
+	                            : probe(&disk, &mem, res);
 
 	/* Print the result */
-	print(join_res, &disk);
+	output(join_res, &disk, out_file);
 }
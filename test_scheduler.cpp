@@ -0,0 +1,153 @@
+/*
+ * Tests for the grant shrinking of Scheduler.
+ * Run with: make test
+ */
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+#include "Scheduler.hpp"
+
+using namespace std;
+
+#define BUDGET_IN_PAGE 40
+
+void check(bool cond, const char* what) {
+	if (!cond) {
+		cerr << "FAIL: " << what << endl;
+		exit(1);
+	}
+	cout << "ok: " << what << endl;
+}
+
+/* Write rows records with keys in [0, keys) to filename */
+void write_relation(const char* filename, uint rows, uint keys, uint seed) {
+	ofstream out(filename);
+	uint x = seed;
+	for (uint i = 0; i < rows; ++i) {
+		x = x * 1103515245u + 12345u;
+		out << (x >> 8) % keys << " " << i << "\n";
+	}
+}
+
+/*
+ * Admission hook that holds the queries in blocked once they are admitted,
+ * until release() is called
+ */
+class AdmitGate {
+public:
+	explicit AdmitGate(std::set<uint> _blocked) : blocked(_blocked) {}
+
+	void operator()(uint query_id) {
+		unique_lock<mutex> lock(m);
+		admitted.insert(query_id);
+		cv.notify_all();
+		if (blocked.count(query_id)) {
+			cv.wait(lock, [&] { return released; });
+		}
+	}
+
+	/* Wait until query_id is admitted and held */
+	void wait_admitted(uint query_id) {
+		unique_lock<mutex> lock(m);
+		cv.wait(lock, [&] { return admitted.count(query_id) > 0; });
+	}
+
+	void release() {
+		lock_guard<mutex> lock(m);
+		released = true;
+		cv.notify_all();
+	}
+
+private:
+	std::set<uint> blocked;
+	std::set<uint> admitted;
+	bool released = false;
+	mutex m;
+	condition_variable cv;
+};
+
+size_t num_pairs(Disk* disk, const QueryStats& stats) {
+	size_t records = 0;
+	for (uint page_id : stats.join_res) {
+		records += disk->diskRead(page_id)->size();
+	}
+	return records / 2;
+}
+
+int main() {
+	const char* left_file = "test_scheduler_left.txt";
+	const char* right_file = "test_scheduler_right.txt";
+	write_relation(left_file, 20000, 3000, 1);
+	write_relation(right_file, 15000, 3000, 2);
+
+	Disk disk(2000000, RECORDS_PER_PAGE);
+	pair<uint, uint> left_rel = disk.read_data(left_file);
+	pair<uint, uint> right_rel = disk.read_data(right_file);
+	remove(left_file);
+	remove(right_file);
+
+	/* Reference: the query alone with the whole budget */
+	QueryStats reference;
+	{
+		Scheduler scheduler(&disk, BUDGET_IN_PAGE);
+		uint query = scheduler.submit(left_rel, right_rel, BUDGET_IN_PAGE);
+		scheduler.wait_all();
+		reference = scheduler.stats(query);
+		check(reference.grant_in_page == BUDGET_IN_PAGE,
+		      "unshrunk query keeps its grant");
+		check(!scheduler.shrink_grant(query, 3),
+		      "shrinking a finished query is refused");
+	}
+
+	/*
+	 * Queued shrink: the first query is held right after admission with the
+	 * whole budget, so the second one is queued until it is released
+	 */
+	{
+		AdmitGate gate({0});
+		Scheduler scheduler(&disk, BUDGET_IN_PAGE);
+		scheduler.on_admit([&](uint query_id) { gate(query_id); });
+		uint first = scheduler.submit(left_rel, right_rel, BUDGET_IN_PAGE);
+		uint second = scheduler.submit(left_rel, right_rel, BUDGET_IN_PAGE);
+		gate.wait_admitted(first);
+		check(!scheduler.admitted(second), "second query is queued");
+		check(scheduler.shrink_grant(second, 3), "queued shrink is accepted");
+		gate.release();
+		scheduler.wait_all();
+		QueryStats stats = scheduler.stats(second);
+		check(scheduler.stats(first).grant_in_page == BUDGET_IN_PAGE,
+		      "first query keeps its grant");
+		check(stats.grant_in_page == 3, "queued query runs with the shrunk grant");
+		check(stats.load_from_disk > reference.load_from_disk,
+		      "queued shrunk query reads more pages");
+		check(num_pairs(&disk, stats) == num_pairs(&disk, reference),
+		      "queued shrunk query returns the same result");
+	}
+
+	/*
+	 * Running shrink: the query is held after admission, before partition(),
+	 * so the shrink is applied before its first bucket is probed
+	 */
+	{
+		AdmitGate gate({0});
+		Scheduler scheduler(&disk, BUDGET_IN_PAGE);
+		scheduler.on_admit([&](uint query_id) { gate(query_id); });
+		uint query = scheduler.submit(left_rel, right_rel, BUDGET_IN_PAGE);
+		gate.wait_admitted(query);
+		check(scheduler.admitted(query), "query is running");
+		check(scheduler.shrink_grant(query, 3), "running shrink is accepted");
+		gate.release();
+		scheduler.wait_all();
+		QueryStats stats = scheduler.stats(query);
+		check(stats.grant_in_page == 3, "running query finishes with the shrunk grant");
+		check(stats.load_from_disk > reference.load_from_disk,
+		      "running shrunk query reads more pages");
+		check(num_pairs(&disk, stats) == num_pairs(&disk, reference),
+		      "running shrunk query returns the same result");
+	}
+	return 0;
+}